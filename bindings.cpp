@@ -0,0 +1,91 @@
+#include "scatterplot.h"
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace py = pybind11;
+
+// The input buffer is reinterpreted as QPointF in place, which requires the two to share their layout
+static_assert( sizeof( QPointF ) == 2 * sizeof( double ) );
+
+namespace
+{
+    // Packed positions and deformations of the final iteration, the sectors are dropped with the scatterplot
+    struct Result
+    {
+        std::vector<QPointF> positions {};
+        std::vector<QPointF> deformations {};
+    };
+
+    // Returns an (N, 2) float64 array viewing 'points', kept alive by 'owner'
+    py::array_t<double> view( const std::vector<QPointF>& points, const py::object& owner )
+    {
+        return py::array_t<double> {
+            std::vector<py::ssize_t> { static_cast<py::ssize_t>( points.size() ), 2 },
+            reinterpret_cast<const double*>( points.data() ),
+            owner
+        };
+    }
+
+    py::tuple regularize( const py::buffer& points, size_t sectors, size_t iterations, size_t field_resolution, bool verbose )
+    {
+        const auto info = points.request();
+        if( info.ndim != 2 || info.shape[1] != 2 || info.format != py::format_descriptor<double>::format() )
+            throw std::invalid_argument { "points must be an (N, 2) float64 array" };
+        if( info.strides[0] != 2 * static_cast<py::ssize_t>( sizeof( double ) ) || info.strides[1] != static_cast<py::ssize_t>( sizeof( double ) ) )
+            throw std::invalid_argument { "points must be C-contiguous" };
+        if( sectors < 2 )
+            throw std::invalid_argument { "sectors must be at least 2" };
+
+        const auto positions = std::span<const QPointF> { static_cast<const QPointF*>( info.ptr ), static_cast<size_t>( info.shape[0] ) };
+
+        // SquareDomain::sector() cannot build sectors outside the domain and would terminate with the GIL released
+        for( const auto& position : positions )
+        {
+            if( !std::isfinite( position.x() ) || !std::isfinite( position.y() ) || std::abs( position.x() ) > 1.0 || std::abs( position.y() ) > 1.0 )
+                throw std::invalid_argument { "points must be finite and inside [-1, 1]^2" };
+        }
+
+        auto result = std::make_unique<Result>();
+        {
+            py::gil_scoped_release release;
+
+            // Timings are only printed when requested, the host process owns stdout
+            const auto field = field_resolution ? std::make_shared<const DeformationField>( sectors, field_resolution, verbose ) : nullptr;
+
+            auto scatterplot = Scatterplot { positions, sectors, Scatterplot::Counting::symmetric_parallel, field, verbose };
+            for( size_t i = 0; i < iterations; ++i )
+                scatterplot = scatterplot.regularize();
+
+            result->positions = scatterplot.positions();
+            result->deformations.reserve( scatterplot.points().size() );
+            for( const auto& point : scatterplot.points() )
+                result->deformations.push_back( point.deformation.total );
+        }
+
+        // Both arrays view the packed result directly, the capsule frees it once neither is referenced anymore
+        const auto& packed = *result;
+        const auto owner = py::capsule { result.release(), [] ( void* pointer )
+        {
+            delete static_cast<Result*>( pointer );
+        } };
+
+        return py::make_tuple( view( packed.positions, owner ), view( packed.deformations, owner ) );
+    }
+}
+
+PYBIND11_MODULE( sector_based_regularization, module )
+{
+    module.doc() = "Sector-based scatterplot regularization";
+
+    module.def( "regularize", &regularize, py::arg( "points" ), py::arg( "sectors" ) = 16, py::arg( "iterations" ) = 1, py::arg( "field_resolution" ) = 0, py::arg( "verbose" ) = false,
+        "Regularizes an (N, 2) float64 array in [-1, 1]^2 for the given number of iterations.\n"
+        "A non-zero field_resolution looks the uniform deformation up in a precomputed field of that resolution.\n"
+        "verbose prints the computation time of every iteration to stdout.\n"
+        "Returns the final positions and deformations as packed (N, 2) arrays viewing native memory." );
+}
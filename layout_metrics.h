@@ -0,0 +1,306 @@
+#pragma once
+
+#include "qpoint.h"
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <thread>
+#include <vector>
+
+// Uniform grid over the bounding box of a point set, stored as one index array sorted by cell
+class SpatialIndex
+{
+public:
+    SpatialIndex() noexcept = default;
+    explicit SpatialIndex( std::span<const QPointF> points ) : _points( points )
+    {
+        if( points.empty() )
+            return;
+
+        auto minimum = points.front();
+        auto maximum = points.front();
+        for( const auto& point : points )
+        {
+            minimum = QPointF { std::min( minimum.x(), point.x() ), std::min( minimum.y(), point.y() ) };
+            maximum = QPointF { std::max( maximum.x(), point.x() ), std::max( maximum.y(), point.y() ) };
+        }
+
+        // About two points per cell
+        _resolution = std::max<size_t>( 1, static_cast<size_t>( std::sqrt( points.size() / 2.0 ) ) );
+        _minimum = minimum;
+        _cell_size = std::max( { maximum.x() - minimum.x(), maximum.y() - minimum.y(), 1e-9 } ) / _resolution;
+
+        _offsets.assign( _resolution * _resolution + 1, 0 );
+        for( const auto& point : points )
+            ++_offsets[this->cell( point ) + 1];
+        for( size_t cell = 0; cell < _resolution * _resolution; ++cell )
+            _offsets[cell + 1] += _offsets[cell];
+
+        _indices.resize( points.size() );
+        auto cursors = std::vector<size_t>( _offsets.begin(), _offsets.end() - 1 );
+        for( size_t i = 0; i < points.size(); ++i )
+            _indices[cursors[this->cell( points[i] )]++] = i;
+    }
+
+    // Whether any point other than 'exclude' lies within 'radius' of 'center', stops at the first one found
+    bool any_within( QPointF center, double radius, size_t exclude ) const
+    {
+        if( _points.empty() )
+            return false;
+
+        const auto [x_begin, y_begin] = this->coordinates( center - QPointF { radius, radius } );
+        const auto [x_end, y_end] = this->coordinates( center + QPointF { radius, radius } );
+
+        for( auto y = y_begin; y <= y_end; ++y )
+        {
+            for( auto x = x_begin; x <= x_end; ++x )
+            {
+                const auto cell = y * _resolution + x;
+                for( auto i = _offsets[cell]; i < _offsets[cell + 1]; ++i )
+                {
+                    const auto index = _indices[i];
+                    if( index != exclude && squared_length( _points[index] - center ) <= radius * radius )
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Writes the indices of the 'k' points closest to 'center', excluding 'exclude', in ascending order of distance
+    void nearest( QPointF center, size_t k, size_t exclude, std::vector<size_t>& result ) const
+    {
+        result.clear();
+
+        // Max-heap of the best candidates so far, ordered by squared distance
+        auto heap = std::vector<std::pair<double, size_t>> {};
+        const auto visit = [&] ( size_t cell )
+        {
+            for( auto i = _offsets[cell]; i < _offsets[cell + 1]; ++i )
+            {
+                const auto index = _indices[i];
+                if( index == exclude )
+                    continue;
+
+                const auto squared_distance = squared_length( _points[index] - center );
+                if( heap.size() < k )
+                {
+                    heap.emplace_back( squared_distance, index );
+                    std::push_heap( heap.begin(), heap.end() );
+                }
+                else if( squared_distance < heap.front().first )
+                {
+                    std::pop_heap( heap.begin(), heap.end() );
+                    heap.back() = { squared_distance, index };
+                    std::push_heap( heap.begin(), heap.end() );
+                }
+            }
+        };
+
+        if( _points.empty() || k == 0 )
+            return;
+
+        // Visit rings of cells around the query cell. Points outside rings 0..r are at least r cells away along one
+        // axis, so the search ends once the k-th candidate is closer than that.
+        const auto [x_center, y_center] = this->coordinates( center );
+        for( size_t ring = 0; ring < _resolution; ++ring )
+        {
+            const auto x_begin = static_cast<int64_t>( x_center ) - static_cast<int64_t>( ring );
+            const auto x_end = static_cast<int64_t>( x_center ) + static_cast<int64_t>( ring );
+            const auto y_begin = static_cast<int64_t>( y_center ) - static_cast<int64_t>( ring );
+            const auto y_end = static_cast<int64_t>( y_center ) + static_cast<int64_t>( ring );
+
+            for( auto y = y_begin; y <= y_end; ++y )
+            {
+                if( y < 0 || y >= static_cast<int64_t>( _resolution ) )
+                    continue;
+
+                // Interior rows only contribute their two boundary cells
+                const auto step = ( y == y_begin || y == y_end ) ? int64_t { 1 } : std::max<int64_t>( x_end - x_begin, 1 );
+                for( auto x = x_begin; x <= x_end; x += step )
+                {
+                    if( x >= 0 && x < static_cast<int64_t>( _resolution ) )
+                        visit( static_cast<size_t>( y ) * _resolution + static_cast<size_t>( x ) );
+                }
+            }
+
+            const auto reach = ring * _cell_size;
+            if( heap.size() == k && heap.front().first <= reach * reach )
+                break;
+        }
+
+        std::sort_heap( heap.begin(), heap.end() );
+        for( const auto& [squared_distance, index] : heap )
+            result.push_back( index );
+    }
+
+private:
+    static double squared_length( QPointF vector )
+    {
+        return vector.x() * vector.x() + vector.y() * vector.y();
+    }
+
+    std::pair<size_t, size_t> coordinates( QPointF point ) const
+    {
+        const auto clamp = [this] ( double value )
+        {
+            return static_cast<size_t>( std::clamp( value / _cell_size, 0.0, static_cast<double>( _resolution - 1 ) ) );
+        };
+        return { clamp( point.x() - _minimum.x() ), clamp( point.y() - _minimum.y() ) };
+    }
+    size_t cell( QPointF point ) const
+    {
+        const auto [x, y] = this->coordinates( point );
+        return y * _resolution + x;
+    }
+
+    std::span<const QPointF> _points {};
+    QPointF _minimum {};
+    double _cell_size {};
+    size_t _resolution {};
+    std::vector<size_t> _offsets {};
+    std::vector<size_t> _indices {};
+};
+
+// Layout-quality metrics of regularized positions against the original embedding. The k nearest neighbors of the
+// original points are computed once, every evaluation then builds one spatial index over the new positions.
+class LayoutMetrics
+{
+public:
+    struct Metrics
+    {
+        size_t overlaps {};                     // Points whose marker overlaps at least one other marker
+        double neighborhood_preservation {};    // Mean fraction of the original k nearest neighbors that are kept
+        double mean_displacement {};            // Mean distance to the original position
+        std::vector<double> compactness {};     // Mean distance to the label centroid, per label
+        double computation_time {};
+    };
+
+    LayoutMetrics() noexcept = default;
+    LayoutMetrics( std::span<const QPointF> original_points, std::span<const uint32_t> labels, size_t k ) :
+        _original_points( original_points.begin(), original_points.end() ),
+        _labels( labels.begin(), labels.end() ),
+        _k( std::min( k, original_points.empty() ? size_t { 0 } : original_points.size() - 1 ) )
+    {
+        const auto index = SpatialIndex { _original_points };
+        _neighbors = this->nearest( index, _original_points );
+    }
+
+    size_t k() const noexcept
+    {
+        return _k;
+    }
+
+    Metrics evaluate( std::span<const QPointF> positions, double marker_radius ) const
+    {
+        const auto time_start = std::chrono::high_resolution_clock::now();
+
+        auto metrics = Metrics {};
+        if( positions.size() != _original_points.size() || positions.empty() )
+            return metrics;
+
+        const auto index = SpatialIndex { positions };
+        const auto neighbors = this->nearest( index, positions );
+
+        // Overlaps and neighborhood preservation, accumulated per thread
+        const auto thread_count = std::clamp<size_t>( std::thread::hardware_concurrency(), 1, positions.size() );
+        auto overlaps = std::vector<size_t>( thread_count );
+        auto preserved = std::vector<size_t>( thread_count );
+        parallel( thread_count, [&] ( size_t thread_index )
+        {
+            const auto begin = positions.size() * thread_index / thread_count;
+            const auto end = positions.size() * ( thread_index + 1 ) / thread_count;
+
+            auto original = std::vector<size_t>( _k );
+            auto current = std::vector<size_t>( _k );
+            for( size_t i = begin; i < end; ++i )
+            {
+                overlaps[thread_index] += index.any_within( positions[i], 2.0 * marker_radius, i );
+
+                std::copy_n( _neighbors.begin() + i * _k, _k, original.begin() );
+                std::copy_n( neighbors.begin() + i * _k, _k, current.begin() );
+                std::sort( original.begin(), original.end() );
+                std::sort( current.begin(), current.end() );
+
+                auto a = original.begin();
+                auto b = current.begin();
+                while( a != original.end() && b != current.end() )
+                {
+                    if( *a < *b ) ++a;
+                    else if( *b < *a ) ++b;
+                    else { ++preserved[thread_index]; ++a; ++b; }
+                }
+            }
+        } );
+
+        for( size_t thread_index = 0; thread_index < thread_count; ++thread_index )
+        {
+            metrics.overlaps += overlaps[thread_index];
+            metrics.neighborhood_preservation += preserved[thread_index];
+        }
+        metrics.neighborhood_preservation = _k == 0 ? 1.0 : metrics.neighborhood_preservation / ( positions.size() * _k );
+
+        // Displacement and per-label compactness
+        const auto label_count = _labels.empty() ? size_t { 0 } : *std::max_element( _labels.begin(), _labels.end() ) + size_t { 1 };
+        auto centroids = std::vector<QPointF>( label_count );
+        auto sizes = std::vector<size_t>( label_count );
+        for( size_t i = 0; i < positions.size(); ++i )
+        {
+            metrics.mean_displacement += std::hypot( positions[i].x() - _original_points[i].x(), positions[i].y() - _original_points[i].y() );
+            if( i < _labels.size() )
+            {
+                centroids[_labels[i]] += positions[i];
+                ++sizes[_labels[i]];
+            }
+        }
+        metrics.mean_displacement /= positions.size();
+
+        metrics.compactness.assign( label_count, 0.0 );
+        for( size_t label = 0; label < label_count; ++label )
+        {
+            if( sizes[label] != 0 )
+                centroids[label] = centroids[label] / static_cast<double>( sizes[label] );
+        }
+        for( size_t i = 0; i < std::min( positions.size(), _labels.size() ); ++i )
+        {
+            const auto difference = positions[i] - centroids[_labels[i]];
+            metrics.compactness[_labels[i]] += std::hypot( difference.x(), difference.y() ) / sizes[_labels[i]];
+        }
+
+        const auto time_end = std::chrono::high_resolution_clock::now();
+        metrics.computation_time = std::chrono::duration_cast<std::chrono::microseconds>( time_end - time_start ).count() / 1000.0;
+        return metrics;
+    }
+
+private:
+    // Row-major k nearest neighbors of every point, queried in parallel
+    std::vector<size_t> nearest( const SpatialIndex& index, std::span<const QPointF> points ) const
+    {
+        auto neighbors = std::vector<size_t>( points.size() * _k );
+        if( points.empty() || _k == 0 )
+            return neighbors;
+
+        const auto thread_count = std::clamp<size_t>( std::thread::hardware_concurrency(), 1, points.size() );
+        parallel( thread_count, [&] ( size_t thread_index )
+        {
+            auto result = std::vector<size_t> {};
+            for( size_t i = points.size() * thread_index / thread_count; i < points.size() * ( thread_index + 1 ) / thread_count; ++i )
+            {
+                index.nearest( points[i], _k, i, result );
+                std::copy( result.begin(), result.end(), neighbors.begin() + i * _k );
+            }
+        } );
+
+        return neighbors;
+    }
+
+    std::vector<QPointF> _original_points {};
+    std::vector<uint32_t> _labels {};
+    size_t _k {};
+    std::vector<size_t> _neighbors {};
+};
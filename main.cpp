@@ -1,9 +1,17 @@
 #include "qapplication.h"
+#include "qcommandlineparser.h"
 #include "qevent.h"
 #include "qlayout.h"
 #include "qpainter.h"
 #include "qwidget.h"
 
+#include "layout_metrics.h"
+#include "result_cache.h"
+#include "scatterplot.h"
+#include "trajectory_store.h"
+
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
@@ -20,315 +28,10 @@ namespace
     }
 }
 
-struct Sector
-{
-    struct
-    {
-        QPointF begin {};
-        QPointF center {};
-        QPointF end {};
-    } intersection;
-
-    struct
-    {
-        QPointF density {};
-        QPointF boundary {};
-        QPointF uniform {};
-    } deformation {};
-
-    QPointF anchor {};
-    double area {};
-    double length {};
-    double points_count {};
-};
-
-struct SquareDomain
-{
-    static inline const auto bottomleft = QPointF { -1.0, -1.0 };
-    static inline const auto bottomright = QPointF { 1.0, -1.0 };
-    static inline const auto topleft = QPointF { -1.0, 1.0 };
-    static inline const auto topright = QPointF { 1.0, 1.0 };
-
-    static inline const auto left = QLineF { bottomleft, topleft };
-    static inline const auto top = QLineF { topleft, topright };
-    static inline const auto right = QLineF { bottomright, topright };
-    static inline const auto bottom = QLineF { bottomleft, bottomright };
-
-    static inline double total_area()
-    {
-        return 4.0;
-    }
-    static inline double total_circumference()
-    {
-        return 8.0;
-    }
-
-    static inline double compute_area( const QPointF& a, const QPointF& b, const QPointF& c )
-    {
-        return 0.5 * std::abs( a.x() * ( b.y() - c.y() ) + b.x() * ( c.y() - a.y() ) + c.x() * ( a.y() - b.y() ) );
-    }
-
-    Sector sector( QPointF position, double radian_begin, double radian_end ) const
-    {
-        Sector sector {};
-
-        const double radian_center = ( radian_begin + radian_end ) / 2.0;
-
-        const QLineF sector_begin_line { position, position + 10.0 * QPointF { std::cos( radian_begin ), std::sin( radian_begin ) } };
-        const QLineF sector_center_line { position, position + 10.0 * QPointF { std::cos( radian_center ), std::sin( radian_center ) } };
-        const QLineF sector_anchor_line { position, position - 10.0 * QPointF { std::cos( radian_center ), std::sin( radian_center ) } };
-        const QLineF sector_end_line { position, position + 10.0 * QPointF { std::cos( radian_end ), std::sin( radian_end ) } };
-
-        if( sector_center_line.intersects( left, &sector.intersection.center ) == QLineF::IntersectType::BoundedIntersection );
-        else if( sector_center_line.intersects( top, &sector.intersection.center ) == QLineF::IntersectType::BoundedIntersection );
-        else if( sector_center_line.intersects( right, &sector.intersection.center ) == QLineF::IntersectType::BoundedIntersection );
-        else if( sector_center_line.intersects( bottom, &sector.intersection.center ) == QLineF::IntersectType::BoundedIntersection );
-        else throw;
-
-        if( sector_anchor_line.intersects( left, &sector.anchor ) == QLineF::IntersectType::BoundedIntersection );
-        else if( sector_anchor_line.intersects( top, &sector.anchor ) == QLineF::IntersectType::BoundedIntersection );
-        else if( sector_anchor_line.intersects( right, &sector.anchor ) == QLineF::IntersectType::BoundedIntersection );
-        else if( sector_anchor_line.intersects( bottom, &sector.anchor ) == QLineF::IntersectType::BoundedIntersection );
-        else throw;
-
-        if( sector_begin_line.intersects( left, &sector.intersection.begin ) == QLineF::IntersectType::BoundedIntersection )
-        {
-            if( sector_end_line.intersects( left, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, sector.intersection.end );
-                sector.length = sector.intersection.begin.y() - sector.intersection.end.y();
-            }
-            else if( sector_end_line.intersects( bottom, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, bottomleft ) + compute_area( position, sector.intersection.end, bottomleft );
-                sector.length = sector.intersection.begin.y() - bottomleft.y() + sector.intersection.end.x() - bottomleft.x();
-            }
-            else if( sector_end_line.intersects( right, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, bottomleft ) + compute_area( position, bottomleft, bottomright ) + compute_area( position, sector.intersection.end, bottomright );
-                sector.length = sector.intersection.begin.y() - bottomleft.y() + bottomright.x() - bottomleft.x() + sector.intersection.end.y() - bottomright.y();
-            }
-            else if( sector_end_line.intersects( top, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                throw;
-            }
-            else throw;
-        }
-        else if( sector_begin_line.intersects( top, &sector.intersection.begin ) == QLineF::IntersectType::BoundedIntersection )
-        {
-            if( sector_end_line.intersects( top, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, sector.intersection.end );
-                sector.length = sector.intersection.begin.x() - sector.intersection.end.x();
-            }
-            else if( sector_end_line.intersects( left, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, topleft ) + compute_area( position, sector.intersection.end, topleft );
-                sector.length = sector.intersection.begin.x() - topleft.x() + topleft.y() - sector.intersection.end.y();
-            }
-            else if( sector_end_line.intersects( bottom, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, topleft ) + compute_area( position, topleft, bottomleft ) + compute_area( position, sector.intersection.end, bottomleft );
-                sector.length = sector.intersection.begin.x() - topleft.x() + topleft.y() - bottomleft.y() + sector.intersection.end.x() - bottomleft.x();
-            }
-            else if( sector_end_line.intersects( right, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                throw;
-            }
-            else throw;
-        }
-        else if( sector_begin_line.intersects( right, &sector.intersection.begin ) == QLineF::IntersectType::BoundedIntersection )
-        {
-            if( sector_end_line.intersects( right, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, sector.intersection.end );
-                sector.length = sector.intersection.end.y() - sector.intersection.begin.y();
-            }
-            else if( sector_end_line.intersects( top, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, topright ) + compute_area( position, sector.intersection.end, topright );
-                sector.length = topright.y() - sector.intersection.begin.y() + topright.x() - sector.intersection.end.x();
-            }
-            else if( sector_end_line.intersects( left, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, topright ) + compute_area( position, topright, topleft ) + compute_area( position, sector.intersection.end, topleft );
-                sector.length = topright.y() - sector.intersection.begin.y() + topright.x() - topleft.x() + topleft.y() - sector.intersection.end.y();
-            }
-            else if( sector_end_line.intersects( bottom, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                throw;
-            }
-            else throw;
-        }
-        else if( sector_begin_line.intersects( bottom, &sector.intersection.begin ) == QLineF::IntersectType::BoundedIntersection )
-        {
-            if( sector_end_line.intersects( bottom, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, sector.intersection.end );
-                sector.length = sector.intersection.end.x() - sector.intersection.begin.x();
-            }
-            else if( sector_end_line.intersects( right, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, bottomright ) + compute_area( position, sector.intersection.end, bottomright );
-                sector.length = bottomright.x() - sector.intersection.begin.x() + sector.intersection.end.y() - bottomright.y();
-            }
-            else if( sector_end_line.intersects( top, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                sector.area = compute_area( position, sector.intersection.begin, bottomright ) + compute_area( position, bottomright, topright ) + compute_area( position, sector.intersection.end, topright );
-                sector.length = bottomright.x() - sector.intersection.begin.x() + topright.y() - bottomright.y() + topright.x() - sector.intersection.end.x();
-            }
-            else if( sector_end_line.intersects( left, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
-            {
-                throw;
-            }
-            else throw;
-        }
-        else throw;
-
-        // sector.length = QLineF { sector.intersection.begin, sector.intersection.end }.length();
-
-        return sector;
-    }
-    void clamp( QPointF& point )
-    {
-        point.setX( std::clamp( point.x(), -0.99, 0.99 ) );
-        point.setY( std::clamp( point.y(), -0.99, 0.99 ) );
-    }
-};
-
-class Scatterplot
-{
-public:
-    Scatterplot() noexcept = default;
-    Scatterplot( const std::vector<QPointF>& points, size_t sectors ) : _points( points.size() )
-    {
-        for( size_t i = 0; i < points.size(); ++i )
-        {
-            _points[i].position = points[i];
-            _points[i].sectors = std::vector<Sector>( sectors );
-        }
-
-        this->compute();
-    }
-
-    const auto& points() const noexcept
-    {
-        return _points;
-    }
-    const auto& domain() const noexcept
-    {
-        return _domain;
-    }
-    double computation_time() const noexcept
-    {
-        return _computation_time;
-    }
-
-    Scatterplot regularize()
-    {
-        std::vector<QPointF> points( _points.size() );
-
-        double absmax = 0.0;
-        for( size_t i = 0; i < _points.size(); ++i )
-        {
-            points[i] = _points[i].position + 0.85 * _points[i].deformation.total;
-            _domain.clamp( points[i] );
-
-            absmax = std::max( absmax, std::abs( points[i].x() ) );
-            absmax = std::max( absmax, std::abs( points[i].y() ) );
-        }
-
-        return Scatterplot { std::move( points ), _points[0].sectors.size() };
-    }
-
-private:
-    void compute()
-    {
-        const auto time_start = std::chrono::high_resolution_clock::now();
-
-        for( size_t current_point_index = 0; current_point_index < _points.size(); ++current_point_index )
-        {
-            auto& current_point = _points[current_point_index];
-            auto& sectors = current_point.sectors;
-            const auto& current_position = current_point.position;
-
-            // Compute sectors
-            const auto sector_radian_step = 2.0 * std::numbers::pi_v<double> / sectors.size();
-            for( uint32_t sector_index = 0; sector_index < sectors.size(); ++sector_index )
-            {
-                const double radian_begin = sector_index * sector_radian_step;
-                const double radian_end = ( sector_index + 1.0 ) * sector_radian_step;
-                sectors[sector_index] = _domain.sector( current_position, radian_begin, radian_end );
-            }
-
-            // Count sector points
-            for( size_t other_point_index = 0; other_point_index < _points.size(); ++other_point_index )
-            {
-                if( current_point_index == other_point_index ) continue;
-
-                const auto& other_position = _points[other_point_index].position;
-                if( other_position == current_position )
-                    continue;
-
-                const auto direction = current_position - other_position;
-                const auto radian = std::atan2( direction.y(), direction.x() );
-
-                const auto t = std::clamp( ( radian + std::numbers::pi_v<double> ) / ( 2.0 * std::numbers::pi_v<double> ), 0.0, 1.0 );
-                const auto sector_index = std::clamp( static_cast<size_t>( t * sectors.size() ), 0ull, sectors.size() - 1 );
-                ++sectors[sector_index].points_count;
-            }
-
-            // Compute deformation
-            current_point.deformation.density = QPointF { 0.0, 0.0 };
-            current_point.deformation.uniform = QPointF { 0.0, 0.0 };
-            current_point.deformation.boundary = QPointF { 0.0, 0.0 };
-
-            for( auto& sector : sectors )
-            {
-                sector.deformation.density = sector.points_count / _points.size() * sector.anchor;
-                sector.deformation.uniform = -sector.area / _domain.total_area() * sector.anchor;
-                sector.deformation.boundary = -0.01 * sector.length / _domain.total_circumference() * sector.anchor;
-
-                current_point.deformation.density += sector.deformation.density;
-                current_point.deformation.uniform += sector.deformation.uniform;
-                current_point.deformation.boundary += sector.deformation.boundary;
-            }
-
-            current_point.deformation.total = current_point.deformation.density + current_point.deformation.uniform; // + current_point.deformation.boundary;
-
-            // if( QLineF { current_point.deformation.total, QPointF {} }.length() < 0.005 )
-            //     current_point.deformation.total = QPointF {};
-        }
-
-        const auto time_end = std::chrono::high_resolution_clock::now();
-        _computation_time = std::chrono::duration_cast<std::chrono::microseconds>( time_end - time_start ).count() / 1000.0;
-        std::cout << "Finished computation in " << _computation_time << " ms." << std::endl;
-    }
-
-    struct Point
-    {
-        QPointF position {};
-
-        std::vector<Sector> sectors {};
-
-        struct
-        {
-            QPointF density {};
-            QPointF boundary {};
-            QPointF uniform {};
-            QPointF total {};
-        } deformation {};
-    };
-
-    std::vector<Point> _points {};
-    SquareDomain _domain {};
-    double _computation_time {};
-};
-
 class ScatterplotWidget : public QWidget
 {
 public:
-    ScatterplotWidget() : QWidget {}
+    ScatterplotWidget( uint64_t cache_budget, size_t field_resolution ) : QWidget {}, _cache { "cache", cache_budget }, _field_resolution( field_resolution )
     {
         this->setFocusPolicy( Qt::WheelFocus );
         this->setFocus();
@@ -407,6 +110,9 @@ public:
 
         if( _labels.size() != _original_points.size() )
             _labels = std::vector<uint32_t>( _original_points.size() );
+
+        _dataset = ResultCache::hash( _original_points );
+        _metrics = LayoutMetrics { _original_points, _labels, 10 };
     }
 
 private:
@@ -415,14 +121,14 @@ private:
         auto painter = QPainter { this };
         painter.setRenderHint( QPainter::Antialiasing, true );
 
-        const auto point_size = 10.0;
+        const auto point_size = _point_size;
 
         const auto default_font = painter.font();
         auto bold_font = painter.font();
         bold_font.setBold( true );
         bold_font.setPointSize( 20 );
 
-        const auto radius = ( std::min( this->width(), this->height() ) - 50.0 ) / 2.0;
+        const auto radius = this->plot_radius();
         const QPointF center = this->rect().center();
         const auto rectangle = QRectF { center - QPointF { radius, radius }, center + QPointF { radius, radius } };
 
@@ -431,14 +137,14 @@ private:
         // painter.drawLine( center - QPointF { 0.0, 5.0 }, rectangle.center() + QPointF { 0.0, 5.0 } );
 
         const auto& scatterplot = this->scatterplot( _sector_count, _iterations );
-        const auto& sector_scatterplots = _scatterplots[_sector_count];
+        const auto& trajectories = _trajectories[_sector_count];
 
         if( _debug && !_render_all )
         {
             std::cout << "[ ---------------------------------------- Debug ---------------------------------------- ]" << std::endl;
 
             const auto& point = scatterplot.points()[_sample_index];
-            const auto& sample_sectors = point.sectors;
+            const auto& sample_sectors = scatterplot.sectors( _sample_index );
 
             double area_sum = 0.0;
             double length_sum = 0.0;
@@ -567,23 +273,26 @@ private:
             painter.drawEllipse( screen, point_size, point_size );
         }
 
-        const auto render_path = [this, &painter, center, radius, point_size, &sector_scatterplots] ( size_t point_index, double width, bool render_checkpoints )
+        const auto render_path = [this, &painter, center, radius, point_size, &trajectories] ( size_t point_index, double width, bool render_checkpoints )
         {
-            for( uint32_t j = 1; j <= _iterations; ++j )
+            auto previous = QPointF {};
+            trajectories.trajectory( point_index, _iterations + 1, [&] ( size_t iteration, QPointF position )
             {
-                const auto previous = center + radius * sector_scatterplots[j - 1].points()[point_index].position;
-                const auto current = center + radius * sector_scatterplots[j].points()[point_index].position;
-
-                painter.setPen( QPen( QColor { 63, 100, 127, 255 }, width, Qt::DashLine ) );
-                painter.drawLine( previous, current );
-                
-                if( render_checkpoints )
+                const auto current = center + radius * position;
+                if( iteration > 0 )
                 {
-                    painter.setPen( Qt::transparent );
-                    painter.setBrush( QColor { 63, 100, 127, 255 } );
-                    painter.drawEllipse( previous, point_size / 2.0, point_size / 2.0 );
+                    painter.setPen( QPen( QColor { 63, 100, 127, 255 }, width, Qt::DashLine ) );
+                    painter.drawLine( previous, current );
+
+                    if( render_checkpoints )
+                    {
+                        painter.setPen( Qt::transparent );
+                        painter.setBrush( QColor { 63, 100, 127, 255 } );
+                        painter.drawEllipse( previous, point_size / 2.0, point_size / 2.0 );
+                    }
                 }
-            }
+                previous = current;
+            } );
         };
 
         // Render point paths
@@ -722,11 +431,27 @@ private:
             _sector_colors = !_sector_colors;
             this->update();
         }
+        else if( event->key() == Qt::Key_F )
+        {
+            _deformation_field = !_deformation_field;
+            _scatterplots.clear();
+            _trajectories.clear();
+            this->update();
+        }
+        else if( event->key() == Qt::Key_T )
+        {
+            const auto& trajectories = _trajectories[_sector_count];
+            const auto filepath = "results/trajectories_s" + std::to_string( _sector_count ) + "_i" + std::to_string( _iterations ) + ".csv";
+            auto stream = std::ofstream { filepath };
+            trajectories.export_csv( stream, _iterations + 1 );
+
+            std::cout << filepath << " (" << trajectories.memory() / 1024.0 << " KiB of trajectories)" << std::endl;
+        }
         else if( event->key() == Qt::Key_E )
         {
-            for( const auto sector_count : { 4, 8, 18, 36, 72, 180, 360, 720 } )
+            for( const auto sector_count : evaluation_sector_counts )
             {
-                for( const auto iterations : { 0, 1, 2, 4, 8, 16, 32, 64, 128, 256 } )
+                for( const auto iterations : evaluation_iterations )
                 {
                     const auto filepath = "results/square_evaluation_s" + std::to_string( sector_count ) + "_i" + std::to_string( iterations ) + ".csv";
                     auto stream = std::ofstream { filepath };
@@ -738,9 +463,10 @@ private:
                     for( size_t point_index = 0; point_index < scatterplot.points().size(); ++point_index )
                     {
                         const auto& point = scatterplot.points()[point_index];
+                        const auto sectors = scatterplot.sectors( point_index );
                         for( size_t sector_index = 0; sector_index < sector_count; ++sector_index )
                         {
-                            const auto& sector = point.sectors[sector_index];
+                            const auto& sector = sectors[sector_index];
                             stream << sector_count << ',' << iterations << ',' << scatterplot.computation_time() << ','
                                 << point_index << ',' << point.position.x() << ',' << point.position.y() << ','
                                 << sector_index << ',' << sector.points_count << ',' << sector.area << ',' << sector.length << '\n';
@@ -749,21 +475,100 @@ private:
                 }
 
                 _scatterplots.clear();
+                _trajectories.clear();
             }
         }
     }
 
+    // Only the latest scatterplot of every sector count stays resident, paths are drawn from the trajectory store. Stepping
+    // back loads a recorded iteration from the result cache or, if it was evicted, replays the iterations from the start.
     const Scatterplot& scatterplot( size_t sector_count, size_t iterations )
     {
-        auto& scatterplots = _scatterplots[sector_count];
-        if( scatterplots.empty() )
-            scatterplots.push_back( Scatterplot { _original_points, sector_count } );
+        auto current = _scatterplots.find( sector_count );
+        if( current != _scatterplots.end() && current->second.iteration > iterations )
+        {
+            _scatterplots.erase( current );
+            current = _scatterplots.end();
 
-        while( iterations >= scatterplots.size() )
-            scatterplots.push_back( scatterplots.back().regularize() );
-        return scatterplots[iterations];
+            const auto field = _deformation_field ? this->field( sector_count ) : nullptr;
+            if( auto scatterplot = _cache.load( _dataset, _original_points.size(), sector_count, iterations, field ) )
+                current = _scatterplots.emplace( sector_count, Iteration { iterations, std::move( *scatterplot ) } ).first;
+        }
+
+        if( current == _scatterplots.end() )
+            current = _scatterplots.emplace( sector_count, Iteration { 0, this->iteration( sector_count, 0, nullptr ) } ).first;
+
+        while( current->second.iteration < iterations )
+        {
+            auto next = this->iteration( sector_count, current->second.iteration + 1, &current->second.scatterplot );
+            current->second = Iteration { current->second.iteration + 1, std::move( next ) };
+        }
+
+        return current->second.scatterplot;
     }
 
+    // Loads an iteration from the cache or computes it from its predecessor. Iterations that were not visited before are
+    // reported and appended to the trajectories.
+    Scatterplot iteration( size_t sector_count, size_t iteration, Scatterplot* previous )
+    {
+        const auto field = _deformation_field ? this->field( sector_count ) : nullptr;
+
+        auto scatterplot = _cache.load( _dataset, _original_points.size(), sector_count, iteration, field );
+        if( !scatterplot )
+        {
+            if( previous )
+                scatterplot = previous->regularize();
+            else
+                scatterplot = Scatterplot { _original_points, sector_count, Scatterplot::Counting::symmetric_parallel, field };
+
+            // Only the iterations exported by the evaluation need their sector counts
+            const auto evaluated = std::find( evaluation_sector_counts.begin(), evaluation_sector_counts.end(), sector_count ) != evaluation_sector_counts.end()
+                && std::find( evaluation_iterations.begin(), evaluation_iterations.end(), iteration ) != evaluation_iterations.end();
+            _cache.store( _dataset, iteration, *scatterplot, evaluated );
+        }
+
+        auto& trajectories = _trajectories[sector_count];
+        if( trajectories.iterations() == iteration )
+        {
+            this->report( *scatterplot, iteration );
+            trajectories.append( *scatterplot );
+        }
+
+        return std::move( *scatterplot );
+    }
+
+    std::shared_ptr<const DeformationField> field( size_t sector_count )
+    {
+        auto& field = _fields[sector_count];
+        if( !field )
+            field = std::make_shared<const DeformationField>( sector_count, _field_resolution );
+        return field;
+    }
+
+    // Half the side length of the plotted domain in pixels
+    double plot_radius() const
+    {
+        return ( std::min( this->width(), this->height() ) - 50.0 ) / 2.0;
+    }
+
+    void report( const Scatterplot& scatterplot, size_t iteration ) const
+    {
+        // Overlaps are counted for the markers as currently rendered, converted from pixels to domain units
+        const auto radius = this->plot_radius();
+        const auto marker_radius = radius > 0.0 ? _point_size / radius : 0.0;
+        const auto metrics = _metrics.evaluate( scatterplot.positions(), marker_radius );
+
+        std::cout << "Iteration " << iteration << " (" << scatterplot.sector_count() << " sectors): overlaps = " << metrics.overlaps
+            << ", " << _metrics.k() << "-NN preservation = " << metrics.neighborhood_preservation
+            << ", mean displacement = " << metrics.mean_displacement << ", compactness = [";
+        for( size_t label = 0; label < metrics.compactness.size(); ++label )
+            std::cout << ( label ? ", " : "" ) << metrics.compactness[label];
+        std::cout << "] in " << metrics.computation_time << " ms." << std::endl;
+    }
+
+    static constexpr auto evaluation_sector_counts = std::array<size_t, 8> { 4, 8, 18, 36, 72, 180, 360, 720 };
+    static constexpr auto evaluation_iterations = std::array<size_t, 10> { 0, 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+
     std::vector<QPointF> _original_points {};
     std::vector<uint32_t> _labels {};
     const std::vector<QColor> _colors {
@@ -773,7 +578,20 @@ private:
         QColor { "#0f718d" }
     };
 
-    std::unordered_map<size_t, std::vector<Scatterplot>> _scatterplots {};
+    struct Iteration
+    {
+        size_t iteration {};
+        Scatterplot scatterplot {};
+    };
+
+    std::unordered_map<size_t, Iteration> _scatterplots {}; // Latest scatterplot of every sector count
+    std::unordered_map<size_t, TrajectoryStore> _trajectories {};
+    ResultCache _cache {};
+    std::unordered_map<size_t, std::shared_ptr<const DeformationField>> _fields {};
+    size_t _field_resolution { 256 };
+    LayoutMetrics _metrics {};
+    double _point_size { 10.0 }; // Radius of the rendered points in pixels
+    uint64_t _dataset {};
     size_t _sector_count { 16 };
     int64_t _iterations { 0 };
     size_t _sample_index { 0 };
@@ -783,19 +601,29 @@ private:
     bool _render_path { false };
     bool _normalize { false };
     bool _sector_colors { false };
+    bool _deformation_field { false };
 };
 
 int main( int argc, char** argv )
 {
     auto application = QApplication { argc, argv };
 
+    // One evaluation sweep of the default dataset (8 sector counts x 257 iterations, counts at the exported ones) takes about 230 MiB
+    auto parser = QCommandLineParser {};
+    parser.addHelpOption();
+    parser.addOption( QCommandLineOption { "cache-budget", "Size of the result cache in MiB before the least recently used files are evicted.", "MiB", "1024" } );
+    parser.addOption( QCommandLineOption { "field-resolution", "Resolution of the precomputed deformation fields toggled with F.", "resolution", "256" } );
+    parser.process( application );
+    const auto cache_budget = parser.value( "cache-budget" ).toULongLong() << 20;
+    const auto field_resolution = std::max<size_t>( parser.value( "field-resolution" ).toULongLong(), 2 );
+
     auto window = QWidget {};
     window.resize( 1920, 1080 );
     window.setWindowTitle( "Sector-based Scatterplot De-cluttering" );
     window.setStyleSheet( "background: white" );
     window.show();
 
-    auto scatterplotWidget = new ScatterplotWidget {};
+    auto scatterplotWidget = new ScatterplotWidget { cache_budget, field_resolution };
 
     auto layout = new QVBoxLayout { &window };
     layout->addWidget( scatterplotWidget );
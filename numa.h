@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// NUMA nodes and their CPUs as reported by /sys/devices/system/node, restricted to the CPUs the process may run on. Machines
+// without that directory, including every non-Linux platform, are reported as a single node holding all allowed CPUs.
+class NumaTopology
+{
+public:
+    struct Node
+    {
+        uint32_t id {};
+        std::vector<uint32_t> cpus {};
+    };
+
+    static const NumaTopology& system()
+    {
+        static const auto topology = NumaTopology { "/sys/devices/system/node" };
+        return topology;
+    }
+
+    explicit NumaTopology( const std::filesystem::path& directory )
+    {
+        const auto allowed = allowed_cpus();
+
+        auto error = std::error_code {};
+        for( const auto& entry : std::filesystem::directory_iterator { directory, error } )
+        {
+            const auto filename = entry.path().filename().string();
+            if( !filename.starts_with( "node" ) || filename.size() == 4 || !std::all_of( filename.begin() + 4, filename.end(), [] ( unsigned char character ) { return std::isdigit( character ) != 0; } ) )
+                continue;
+
+            auto stream = std::ifstream { entry.path() / "cpulist" };
+            auto cpulist = std::string {};
+            if( !std::getline( stream, cpulist ) )
+                continue;
+
+            // Memory-only nodes and nodes outside the affinity mask (cgroups, taskset) have no CPUs to run workers on
+            auto node = Node { static_cast<uint32_t>( std::stoul( filename.substr( 4 ) ) ), parse_cpulist( cpulist ) };
+            if( !allowed.empty() )
+            {
+                std::erase_if( node.cpus, [&allowed] ( uint32_t cpu ) { return !std::binary_search( allowed.begin(), allowed.end(), cpu ); } );
+            }
+            if( !node.cpus.empty() )
+                _nodes.push_back( std::move( node ) );
+        }
+
+        std::sort( _nodes.begin(), _nodes.end(), [] ( const Node& a, const Node& b ) { return a.id < b.id; } );
+
+        if( _nodes.empty() )
+        {
+            auto& node = _nodes.emplace_back();
+            node.cpus = allowed;
+            if( node.cpus.empty() )
+            {
+                node.cpus.resize( std::max( 1u, std::thread::hardware_concurrency() ) );
+                for( uint32_t cpu = 0; cpu < node.cpus.size(); ++cpu )
+                    node.cpus[cpu] = cpu;
+            }
+        }
+    }
+
+    const auto& nodes() const noexcept
+    {
+        return _nodes;
+    }
+    // False once pinning has failed, callers then keep to unpinned execution
+    bool pinnable() const noexcept
+    {
+        return _pinnable;
+    }
+
+    // Restricts the calling thread to the CPUs of the node, returns false where pinning is unsupported or failed
+    bool pin( const Node& node ) const
+    {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO( &set );
+        for( const auto cpu : node.cpus )
+        {
+            if( cpu < CPU_SETSIZE )
+                CPU_SET( cpu, &set );
+        }
+        if( pthread_setaffinity_np( pthread_self(), sizeof( set ), &set ) == 0 )
+            return true;
+#endif
+        _pinnable = false;
+        return false;
+    }
+
+    // Sorted CPUs of the process' affinity mask, empty where it cannot be queried
+    static std::vector<uint32_t> allowed_cpus()
+    {
+        auto cpus = std::vector<uint32_t> {};
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO( &set );
+        if( sched_getaffinity( 0, sizeof( set ), &set ) == 0 )
+        {
+            for( uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+            {
+                if( CPU_ISSET( cpu, &set ) )
+                    cpus.push_back( cpu );
+            }
+        }
+#endif
+        return cpus;
+    }
+
+    // Parses the kernel's list format, e.g. "0-3,8-11"
+    static std::vector<uint32_t> parse_cpulist( const std::string& cpulist )
+    {
+        auto cpus = std::vector<uint32_t> {};
+
+        auto stream = std::stringstream { cpulist };
+        auto range = std::string {};
+        while( std::getline( stream, range, ',' ) )
+        {
+            if( range.empty() || !std::isdigit( static_cast<unsigned char>( range.front() ) ) )
+                continue;
+
+            const auto separator = range.find( '-' );
+            const auto first = static_cast<uint32_t>( std::stoul( range.substr( 0, separator ) ) );
+            const auto last = separator == std::string::npos ? first : static_cast<uint32_t>( std::stoul( range.substr( separator + 1 ) ) );
+            for( auto cpu = first; cpu <= last; ++cpu )
+                cpus.push_back( cpu );
+        }
+
+        return cpus;
+    }
+
+private:
+    std::vector<Node> _nodes {};
+    mutable std::atomic<bool> _pinnable { true };
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Runs the callback on 'thread_count' threads (including the calling one) and joins them
+template<typename Callback>
+void parallel( size_t thread_count, Callback&& callback )
+{
+    auto threads = std::vector<std::thread> {};
+    for( size_t thread_index = 1; thread_index < thread_count; ++thread_index )
+        threads.emplace_back( std::ref( callback ), thread_index );
+
+    callback( size_t { 0 } );
+    for( auto& thread : threads )
+        thread.join();
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include "qfile.h"
+
+#include "scatterplot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+// Persists regularization results across runs. Every (dataset, domain, sector count, iteration, field resolution) is stored in its own
+// memory-mappable file; the least recently loaded or stored files are evicted once the directory exceeds its budget.
+class ResultCache
+{
+public:
+    // File layout: Header, positions (N x 2 doubles), deformations (density, uniform, boundary and total, each N x 2 doubles),
+    // optionally followed by the sector point counts (N x S integers of 'counts_size' bytes)
+    struct Header
+    {
+        uint64_t magic {};
+        uint32_t version {};
+        uint32_t counts_size {};
+        uint64_t dataset {};
+        uint64_t points_count {};
+        uint64_t sector_count {};
+        uint64_t iteration {};
+        double computation_time {};
+        uint64_t padding {};
+    };
+    static_assert( sizeof( Header ) == 64 );
+
+    static constexpr uint64_t magic = 0x5342524341434845; // "SBRCACHE"
+    static constexpr uint32_t version = 2;
+
+    ResultCache() noexcept = default;
+    ResultCache( std::filesystem::path directory, uint64_t budget ) : _directory( std::move( directory ) ), _budget( budget )
+    {
+    }
+
+    // FNV-1a over the raw coordinates, identifies the dataset a sequence of iterations was computed from
+    static uint64_t hash( std::span<const QPointF> points )
+    {
+        uint64_t hash = 0xcbf29ce484222325;
+        for( const auto& point : points )
+        {
+            for( const double coordinate : { point.x(), point.y() } )
+            {
+                unsigned char bytes[sizeof( double )];
+                std::memcpy( bytes, &coordinate, sizeof( double ) );
+                for( const auto byte : bytes )
+                    hash = ( hash ^ byte ) * 0x100000001b3;
+            }
+        }
+        return hash;
+    }
+
+    // Files are only restored if they match the dataset hash and its point count, which guards against hash collisions
+    std::optional<Scatterplot> load( uint64_t dataset, size_t points_count, size_t sector_count, size_t iteration, std::shared_ptr<const DeformationField> field = nullptr )
+    {
+        this->scan();
+
+        const auto filepath = this->filepath( dataset, sector_count, iteration, field.get() );
+        const auto entry = _entries.find( filepath.filename().string() );
+        if( entry == _entries.end() )
+            return std::nullopt;
+
+        auto file = QFile { filepath };
+        if( !file.open( QIODevice::ReadOnly ) || file.size() < static_cast<qint64>( sizeof( Header ) ) )
+        {
+            this->remove( filepath );
+            return std::nullopt;
+        }
+
+        auto* memory = file.map( 0, file.size() );
+        if( !memory )
+            return std::nullopt;
+
+        auto header = Header {};
+        std::memcpy( &header, memory, sizeof( Header ) );
+
+        const auto counts_offset = sizeof( Header ) + 5 * points_count * sizeof( QPointF );
+        const auto expected_size = counts_offset + points_count * header.sector_count * header.counts_size;
+        if( header.magic != magic || header.version != version || header.dataset != dataset || header.points_count != points_count || header.sector_count != sector_count
+            || header.iteration != iteration || ( header.counts_size != 0 && header.counts_size != 2 && header.counts_size != 4 )
+            || static_cast<uint64_t>( file.size() ) != expected_size )
+        {
+            std::cout << "Discarding invalid cache file " << filepath.string() << std::endl;
+
+            file.unmap( memory );
+            file.close();
+            this->remove( filepath );
+            return std::nullopt;
+        }
+
+        const auto* positions = reinterpret_cast<const QPointF*>( memory + sizeof( Header ) );
+        const auto* deformations = positions + points_count;
+
+        auto points_counts = std::vector<uint32_t>( header.counts_size ? points_count * sector_count : 0 );
+        for( size_t i = 0; i < points_counts.size(); ++i )
+        {
+            if( header.counts_size == 2 )
+                points_counts[i] = reinterpret_cast<const uint16_t*>( memory + counts_offset )[i];
+            else
+                points_counts[i] = reinterpret_cast<const uint32_t*>( memory + counts_offset )[i];
+        }
+
+        auto scatterplot = Scatterplot::restore(
+            std::span<const QPointF> { positions, points_count },
+            std::span<const QPointF> { deformations, 4 * points_count },
+            points_counts,
+            sector_count,
+            header.computation_time,
+            std::move( field )
+        );
+
+        file.unmap( memory );
+        file.close();
+
+        // The modification time doubles as the last access time for eviction across runs
+        auto error = std::error_code {};
+        entry->second.time = std::filesystem::file_time_type::clock::now();
+        std::filesystem::last_write_time( filepath, entry->second.time, error );
+
+        return scatterplot;
+    }
+
+    // Stores positions and deformations; the sector counts are only kept when 'counts' is set, since they dominate the size
+    void store( uint64_t dataset, size_t iteration, const Scatterplot& scatterplot, bool counts )
+    {
+        this->scan();
+
+        auto error = std::error_code {};
+        std::filesystem::create_directories( _directory, error );
+        if( error )
+            return;
+
+        const auto& points = scatterplot.points();
+        const auto sector_count = scatterplot.sector_count();
+
+        // Counts never exceed N - 1, so 16 bits suffice for all but the largest datasets
+        const auto has_counts = counts && std::all_of( points.begin(), points.end(), [sector_count] ( const auto& point ) { return point.sectors.size() == sector_count; } );
+        const auto counts_size = has_counts ? ( points.size() <= 65536 ? uint32_t { 2 } : uint32_t { 4 } ) : uint32_t { 0 };
+        const auto header = Header { magic, version, counts_size, dataset, points.size(), sector_count, iteration, scatterplot.computation_time(), 0 };
+
+        auto blocks = std::vector<QPointF>( 5 * points.size() );
+        for( size_t i = 0; i < points.size(); ++i )
+        {
+            blocks[i] = points[i].position;
+            blocks[1 * points.size() + i] = points[i].deformation.density;
+            blocks[2 * points.size() + i] = points[i].deformation.uniform;
+            blocks[3 * points.size() + i] = points[i].deformation.boundary;
+            blocks[4 * points.size() + i] = points[i].deformation.total;
+        }
+
+        auto points_counts = std::vector<char>( points.size() * sector_count * counts_size );
+        for( size_t i = 0; counts_size && i < points.size(); ++i )
+        {
+            for( size_t sector_index = 0; sector_index < sector_count; ++sector_index )
+            {
+                const auto offset = ( i * sector_count + sector_index ) * counts_size;
+                const auto points_count = static_cast<uint32_t>( points[i].sectors[sector_index].points_count );
+                if( counts_size == 2 )
+                {
+                    const auto value = static_cast<uint16_t>( points_count );
+                    std::memcpy( points_counts.data() + offset, &value, sizeof( value ) );
+                }
+                else
+                {
+                    std::memcpy( points_counts.data() + offset, &points_count, sizeof( points_count ) );
+                }
+            }
+        }
+
+        // Write to a temporary file first so that an interrupted run never leaves a truncated entry behind
+        const auto filepath = this->filepath( dataset, sector_count, iteration, scatterplot.field().get() );
+        auto temporary = filepath;
+        temporary += ".tmp";
+        {
+            auto stream = std::ofstream { temporary, std::ios::binary };
+            stream.write( reinterpret_cast<const char*>( &header ), sizeof( Header ) );
+            stream.write( reinterpret_cast<const char*>( blocks.data() ), blocks.size() * sizeof( QPointF ) );
+            stream.write( points_counts.data(), points_counts.size() );
+            if( !stream )
+            {
+                stream.close();
+                std::filesystem::remove( temporary, error );
+                return;
+            }
+        }
+
+        std::filesystem::rename( temporary, filepath, error );
+        if( error )
+        {
+            std::filesystem::remove( temporary, error );
+            return;
+        }
+
+        const auto size = sizeof( Header ) + blocks.size() * sizeof( QPointF ) + points_counts.size();
+        auto& entry = _entries[filepath.filename().string()];
+        _total_size += size - entry.size;
+        entry = Entry { std::filesystem::file_time_type::clock::now(), size };
+
+        if( _total_size > _budget )
+            this->evict();
+    }
+
+    uint64_t budget() const noexcept
+    {
+        return _budget;
+    }
+    uint64_t size() const noexcept
+    {
+        return _total_size;
+    }
+
+private:
+    struct Entry
+    {
+        std::filesystem::file_time_type time {};
+        uint64_t size {};
+    };
+
+    std::filesystem::path filepath( uint64_t dataset, size_t sector_count, size_t iteration, const DeformationField* field ) const
+    {
+        auto filename = std::stringstream {};
+        filename << SquareDomain::name << '_' << std::hex << dataset << std::dec << "_s" << sector_count << "_i" << iteration;
+        if( field )
+            filename << "_f" << field->resolution();
+        filename << ".bin";
+        return _directory / filename.str();
+    }
+
+    // Indexes the files of earlier runs once, afterwards the index and total size are kept up to date incrementally
+    void scan()
+    {
+        if( _scanned )
+            return;
+        _scanned = true;
+
+        auto error = std::error_code {};
+        for( const auto& file : std::filesystem::directory_iterator { _directory, error } )
+        {
+            if( !file.is_regular_file( error ) || file.path().extension() != ".bin" )
+                continue;
+
+            const auto size = file.file_size( error );
+            const auto time = file.last_write_time( error );
+            if( error )
+                continue;
+
+            _entries[file.path().filename().string()] = Entry { time, size };
+            _total_size += size;
+        }
+    }
+
+    void remove( const std::filesystem::path& filepath )
+    {
+        auto error = std::error_code {};
+        std::filesystem::remove( filepath, error );
+
+        const auto entry = _entries.find( filepath.filename().string() );
+        if( entry != _entries.end() )
+        {
+            _total_size -= entry->second.size;
+            _entries.erase( entry );
+        }
+    }
+
+    // Removes the least recently used files until the cache fits into its budget
+    void evict()
+    {
+        auto entries = std::vector<std::pair<std::filesystem::file_time_type, std::string>> {};
+        for( const auto& [filename, entry] : _entries )
+            entries.emplace_back( entry.time, filename );
+        std::sort( entries.begin(), entries.end() );
+
+        for( const auto& [time, filename] : entries )
+        {
+            if( _total_size <= _budget )
+                break;
+            this->remove( _directory / filename );
+        }
+    }
+
+    std::filesystem::path _directory { "cache" };
+    uint64_t _budget { 1ull << 30 };
+    bool _scanned { false };
+    std::unordered_map<std::string, Entry> _entries {};
+    uint64_t _total_size {};
+};
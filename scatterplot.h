@@ -0,0 +1,796 @@
+#pragma once
+
+#include "qline.h"
+#include "qpoint.h"
+
+#include "numa.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numbers>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+struct Sector
+{
+    struct
+    {
+        QPointF begin {};
+        QPointF center {};
+        QPointF end {};
+    } intersection;
+
+    struct
+    {
+        QPointF density {};
+        QPointF boundary {};
+        QPointF uniform {};
+    } deformation {};
+
+    QPointF anchor {};
+    double area {};
+    double length {};
+    double points_count {};
+};
+
+struct SquareDomain
+{
+    static constexpr auto name = std::string_view { "square" };
+
+    static inline const auto bottomleft = QPointF { -1.0, -1.0 };
+    static inline const auto bottomright = QPointF { 1.0, -1.0 };
+    static inline const auto topleft = QPointF { -1.0, 1.0 };
+    static inline const auto topright = QPointF { 1.0, 1.0 };
+
+    static inline const auto left = QLineF { bottomleft, topleft };
+    static inline const auto top = QLineF { topleft, topright };
+    static inline const auto right = QLineF { bottomright, topright };
+    static inline const auto bottom = QLineF { bottomleft, bottomright };
+
+    static inline double total_area()
+    {
+        return 4.0;
+    }
+    static inline double total_circumference()
+    {
+        return 8.0;
+    }
+
+    static inline double compute_area( const QPointF& a, const QPointF& b, const QPointF& c )
+    {
+        return 0.5 * std::abs( a.x() * ( b.y() - c.y() ) + b.x() * ( c.y() - a.y() ) + c.x() * ( a.y() - b.y() ) );
+    }
+
+    // Point where the ray from 'position' along the unit vector 'direction' leaves the domain, i.e. what sector() computes
+    // as the anchor for the direction of center + pi, without the remaining intersections and areas
+    QPointF exit( QPointF position, QPointF direction ) const
+    {
+        auto distance = std::numeric_limits<double>::infinity();
+        if( direction.x() > 0.0 ) distance = std::min( distance, ( topright.x() - position.x() ) / direction.x() );
+        if( direction.x() < 0.0 ) distance = std::min( distance, ( bottomleft.x() - position.x() ) / direction.x() );
+        if( direction.y() > 0.0 ) distance = std::min( distance, ( topright.y() - position.y() ) / direction.y() );
+        if( direction.y() < 0.0 ) distance = std::min( distance, ( bottomleft.y() - position.y() ) / direction.y() );
+
+        return position + distance * direction;
+    }
+
+    Sector sector( QPointF position, double radian_begin, double radian_end ) const
+    {
+        Sector sector {};
+
+        const double radian_center = ( radian_begin + radian_end ) / 2.0;
+
+        const QLineF sector_begin_line { position, position + 10.0 * QPointF { std::cos( radian_begin ), std::sin( radian_begin ) } };
+        const QLineF sector_center_line { position, position + 10.0 * QPointF { std::cos( radian_center ), std::sin( radian_center ) } };
+        const QLineF sector_anchor_line { position, position - 10.0 * QPointF { std::cos( radian_center ), std::sin( radian_center ) } };
+        const QLineF sector_end_line { position, position + 10.0 * QPointF { std::cos( radian_end ), std::sin( radian_end ) } };
+
+        if( sector_center_line.intersects( left, &sector.intersection.center ) == QLineF::IntersectType::BoundedIntersection );
+        else if( sector_center_line.intersects( top, &sector.intersection.center ) == QLineF::IntersectType::BoundedIntersection );
+        else if( sector_center_line.intersects( right, &sector.intersection.center ) == QLineF::IntersectType::BoundedIntersection );
+        else if( sector_center_line.intersects( bottom, &sector.intersection.center ) == QLineF::IntersectType::BoundedIntersection );
+        else throw;
+
+        if( sector_anchor_line.intersects( left, &sector.anchor ) == QLineF::IntersectType::BoundedIntersection );
+        else if( sector_anchor_line.intersects( top, &sector.anchor ) == QLineF::IntersectType::BoundedIntersection );
+        else if( sector_anchor_line.intersects( right, &sector.anchor ) == QLineF::IntersectType::BoundedIntersection );
+        else if( sector_anchor_line.intersects( bottom, &sector.anchor ) == QLineF::IntersectType::BoundedIntersection );
+        else throw;
+
+        if( sector_begin_line.intersects( left, &sector.intersection.begin ) == QLineF::IntersectType::BoundedIntersection )
+        {
+            if( sector_end_line.intersects( left, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, sector.intersection.end );
+                sector.length = sector.intersection.begin.y() - sector.intersection.end.y();
+            }
+            else if( sector_end_line.intersects( bottom, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, bottomleft ) + compute_area( position, sector.intersection.end, bottomleft );
+                sector.length = sector.intersection.begin.y() - bottomleft.y() + sector.intersection.end.x() - bottomleft.x();
+            }
+            else if( sector_end_line.intersects( right, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, bottomleft ) + compute_area( position, bottomleft, bottomright ) + compute_area( position, sector.intersection.end, bottomright );
+                sector.length = sector.intersection.begin.y() - bottomleft.y() + bottomright.x() - bottomleft.x() + sector.intersection.end.y() - bottomright.y();
+            }
+            else if( sector_end_line.intersects( top, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                throw;
+            }
+            else throw;
+        }
+        else if( sector_begin_line.intersects( top, &sector.intersection.begin ) == QLineF::IntersectType::BoundedIntersection )
+        {
+            if( sector_end_line.intersects( top, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, sector.intersection.end );
+                sector.length = sector.intersection.begin.x() - sector.intersection.end.x();
+            }
+            else if( sector_end_line.intersects( left, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, topleft ) + compute_area( position, sector.intersection.end, topleft );
+                sector.length = sector.intersection.begin.x() - topleft.x() + topleft.y() - sector.intersection.end.y();
+            }
+            else if( sector_end_line.intersects( bottom, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, topleft ) + compute_area( position, topleft, bottomleft ) + compute_area( position, sector.intersection.end, bottomleft );
+                sector.length = sector.intersection.begin.x() - topleft.x() + topleft.y() - bottomleft.y() + sector.intersection.end.x() - bottomleft.x();
+            }
+            else if( sector_end_line.intersects( right, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                throw;
+            }
+            else throw;
+        }
+        else if( sector_begin_line.intersects( right, &sector.intersection.begin ) == QLineF::IntersectType::BoundedIntersection )
+        {
+            if( sector_end_line.intersects( right, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, sector.intersection.end );
+                sector.length = sector.intersection.end.y() - sector.intersection.begin.y();
+            }
+            else if( sector_end_line.intersects( top, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, topright ) + compute_area( position, sector.intersection.end, topright );
+                sector.length = topright.y() - sector.intersection.begin.y() + topright.x() - sector.intersection.end.x();
+            }
+            else if( sector_end_line.intersects( left, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, topright ) + compute_area( position, topright, topleft ) + compute_area( position, sector.intersection.end, topleft );
+                sector.length = topright.y() - sector.intersection.begin.y() + topright.x() - topleft.x() + topleft.y() - sector.intersection.end.y();
+            }
+            else if( sector_end_line.intersects( bottom, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                throw;
+            }
+            else throw;
+        }
+        else if( sector_begin_line.intersects( bottom, &sector.intersection.begin ) == QLineF::IntersectType::BoundedIntersection )
+        {
+            if( sector_end_line.intersects( bottom, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, sector.intersection.end );
+                sector.length = sector.intersection.end.x() - sector.intersection.begin.x();
+            }
+            else if( sector_end_line.intersects( right, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, bottomright ) + compute_area( position, sector.intersection.end, bottomright );
+                sector.length = bottomright.x() - sector.intersection.begin.x() + sector.intersection.end.y() - bottomright.y();
+            }
+            else if( sector_end_line.intersects( top, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                sector.area = compute_area( position, sector.intersection.begin, bottomright ) + compute_area( position, bottomright, topright ) + compute_area( position, sector.intersection.end, topright );
+                sector.length = bottomright.x() - sector.intersection.begin.x() + topright.y() - bottomright.y() + topright.x() - sector.intersection.end.x();
+            }
+            else if( sector_end_line.intersects( left, &sector.intersection.end ) == QLineF::IntersectionType::BoundedIntersection )
+            {
+                throw;
+            }
+            else throw;
+        }
+        else throw;
+
+        // sector.length = QLineF { sector.intersection.begin, sector.intersection.end }.length();
+
+        return sector;
+    }
+    void clamp( QPointF& point )
+    {
+        point.setX( std::clamp( point.x(), -0.99, 0.99 ) );
+        point.setY( std::clamp( point.y(), -0.99, 0.99 ) );
+    }
+};
+
+// Uniform and boundary deformation of the square domain sampled on a regular grid over [-1, 1]^2. Both terms only
+// depend on the position and the sector count, never on the data, so one field serves every dataset and iteration.
+// Lookups interpolate bilinearly, extrapolating linearly in the outer half cell.
+class DeformationField
+{
+public:
+    // 'verbose' prints the build time and the sampled error to std::cout
+    DeformationField( size_t sector_count, size_t resolution, bool verbose = true ) : _sector_count( sector_count ), _resolution( std::max<size_t>( resolution, 2 ) )
+    {
+        const auto time_start = std::chrono::high_resolution_clock::now();
+
+        // The anchor rays only depend on the sector count, so the per-point anchors need no trigonometry
+        const auto sector_radian_step = 2.0 * std::numbers::pi_v<double> / _sector_count;
+        _anchor_directions.resize( _sector_count );
+        for( size_t sector_index = 0; sector_index < _sector_count; ++sector_index )
+        {
+            const auto radian = ( sector_index * sector_radian_step + ( sector_index + 1.0 ) * sector_radian_step ) / 2.0 + std::numbers::pi_v<double>;
+            _anchor_directions[sector_index] = QPointF { std::cos( radian ), std::sin( radian ) };
+        }
+        const auto thread_count = std::clamp<size_t>( std::thread::hardware_concurrency(), 1, _resolution );
+
+        // Nodes sit at the cell centers, so none of them lies on the domain boundary
+        _uniform.resize( _resolution * _resolution );
+        _boundary.resize( _resolution * _resolution );
+        parallel( thread_count, [this, thread_count] ( size_t thread_index )
+        {
+            for( size_t y = thread_index; y < _resolution; y += thread_count )
+            {
+                for( size_t x = 0; x < _resolution; ++x )
+                {
+                    const auto node = QPointF { this->coordinate( x ), this->coordinate( y ) };
+                    std::tie( _uniform[y * _resolution + x], _boundary[y * _resolution + x] ) = evaluate( node, _sector_count );
+                }
+            }
+        } );
+
+        // Estimate the error against the exact terms on a grid that is offset from the nodes and reaches the clamped boundary.
+        // This is the largest error at R x R sample positions, not a bound: the exact terms have kinks wherever a sector
+        // boundary passes through a domain corner, and the error between the samples can be larger.
+        auto errors = std::vector<double>( thread_count );
+        parallel( thread_count, [this, thread_count, &errors] ( size_t thread_index )
+        {
+            const auto sample = [this] ( size_t index ) { return -0.99 + 1.98 * index / ( _resolution - 1.0 ); };
+            for( size_t y = thread_index; y < _resolution; y += thread_count )
+            {
+                for( size_t x = 0; x < _resolution; ++x )
+                {
+                    const auto position = QPointF { sample( x ), sample( y ) };
+                    const auto [uniform, boundary] = evaluate( position, _sector_count );
+                    const auto uniform_error = this->uniform( position ) - uniform;
+                    const auto boundary_error = this->boundary( position ) - boundary;
+
+                    errors[thread_index] = std::max( {
+                        errors[thread_index],
+                        std::hypot( uniform_error.x(), uniform_error.y() ),
+                        std::hypot( boundary_error.x(), boundary_error.y() )
+                    } );
+                }
+            }
+        } );
+        _sampled_error = *std::max_element( errors.begin(), errors.end() );
+
+        const auto time_end = std::chrono::high_resolution_clock::now();
+        const auto time = std::chrono::duration_cast<std::chrono::microseconds>( time_end - time_start ).count() / 1000.0;
+        if( verbose )
+            std::cout << "Built " << _resolution << "x" << _resolution << " deformation field for " << _sector_count << " sectors in " << time
+                << " ms, sampled interpolation error " << _sampled_error << " (estimate, maximum over " << _resolution << "x" << _resolution << " positions)." << std::endl;
+    }
+
+    // Exact uniform and boundary deformation at a position, summed over all sectors
+    static std::pair<QPointF, QPointF> evaluate( QPointF position, size_t sector_count )
+    {
+        const auto domain = SquareDomain {};
+        const auto sector_radian_step = 2.0 * std::numbers::pi_v<double> / sector_count;
+
+        auto uniform = QPointF { 0.0, 0.0 };
+        auto boundary = QPointF { 0.0, 0.0 };
+        for( size_t sector_index = 0; sector_index < sector_count; ++sector_index )
+        {
+            const auto sector = domain.sector( position, sector_index * sector_radian_step, ( sector_index + 1.0 ) * sector_radian_step );
+            uniform += -sector.area / domain.total_area() * sector.anchor;
+            boundary += -0.01 * sector.length / domain.total_circumference() * sector.anchor;
+        }
+        return { uniform, boundary };
+    }
+
+    size_t sector_count() const noexcept
+    {
+        return _sector_count;
+    }
+    size_t resolution() const noexcept
+    {
+        return _resolution;
+    }
+    // Unit vector from a point towards the anchor of every sector
+    const auto& anchor_directions() const noexcept
+    {
+        return _anchor_directions;
+    }
+    // Largest interpolation error found at the sample positions, an estimate rather than a bound
+    double sampled_error() const noexcept
+    {
+        return _sampled_error;
+    }
+
+    QPointF uniform( QPointF position ) const
+    {
+        return this->sample( _uniform, position );
+    }
+    QPointF boundary( QPointF position ) const
+    {
+        return this->sample( _boundary, position );
+    }
+
+private:
+    double coordinate( size_t index ) const
+    {
+        return -1.0 + ( index + 0.5 ) * 2.0 / _resolution;
+    }
+
+    QPointF sample( const std::vector<QPointF>& values, QPointF position ) const
+    {
+        const auto u = ( position.x() + 1.0 ) / 2.0 * _resolution - 0.5;
+        const auto v = ( position.y() + 1.0 ) / 2.0 * _resolution - 0.5;
+        const auto x = static_cast<size_t>( std::clamp( std::floor( u ), 0.0, _resolution - 2.0 ) );
+        const auto y = static_cast<size_t>( std::clamp( std::floor( v ), 0.0, _resolution - 2.0 ) );
+        const auto tx = u - x;
+        const auto ty = v - y;
+
+        const auto* row = &values[y * _resolution + x];
+        const auto bottom = ( 1.0 - tx ) * row[0] + tx * row[1];
+        const auto top = ( 1.0 - tx ) * row[_resolution] + tx * row[_resolution + 1];
+        return ( 1.0 - ty ) * bottom + ty * top;
+    }
+
+    size_t _sector_count {};
+    size_t _resolution {};
+    double _sampled_error {};
+    std::vector<QPointF> _uniform {};
+    std::vector<QPointF> _boundary {};
+    std::vector<QPointF> _anchor_directions {};
+};
+
+class Scatterplot
+{
+public:
+    enum class Counting
+    {
+        pairwise,           // Every ordered pair, one atan2 per pair and side
+        symmetric,          // Every unordered pair once, both endpoints incremented
+        symmetric_parallel  // Symmetric with per-thread count buffers and a reduction
+    };
+
+    Scatterplot() noexcept = default;
+    // 'verbose' prints the computation time to std::cout, it is passed on to the regularized scatterplots
+    Scatterplot( std::span<const QPointF> points, size_t sectors, Counting counting = Counting::symmetric_parallel, std::shared_ptr<const DeformationField> field = nullptr, bool verbose = true ) :
+        _points( points.size() ), _sector_count( sectors ), _counting( counting ), _field( std::move( field ) ), _verbose( verbose )
+    {
+        for( size_t i = 0; i < points.size(); ++i )
+            _points[i].position = points[i];
+
+        this->compute();
+    }
+
+    // Restores a scatterplot from cached positions and deformations. 'deformations' holds four blocks of one entry per
+    // point (density, uniform, boundary, total); 'points_counts' holds one row of 'sectors' counts per point or is empty.
+    // Sector geometry is rebuilt on demand by sectors().
+    static Scatterplot restore( std::span<const QPointF> points, std::span<const QPointF> deformations, std::span<const uint32_t> points_counts, size_t sectors, double computation_time, std::shared_ptr<const DeformationField> field = nullptr )
+    {
+        auto scatterplot = Scatterplot {};
+        scatterplot._points.resize( points.size() );
+        scatterplot._sector_count = sectors;
+        scatterplot._field = std::move( field );
+        scatterplot._computation_time = computation_time;
+        scatterplot._points_counts.assign( points_counts.begin(), points_counts.end() );
+
+        const auto count = points.size();
+        for( size_t i = 0; i < count; ++i )
+        {
+            auto& point = scatterplot._points[i];
+            point.position = points[i];
+            point.deformation.density = deformations[i];
+            point.deformation.uniform = deformations[count + i];
+            point.deformation.boundary = deformations[2 * count + i];
+            point.deformation.total = deformations[3 * count + i];
+        }
+
+        return scatterplot;
+    }
+
+    const auto& points() const noexcept
+    {
+        return _points;
+    }
+    // Packed copy of all positions, keeps the counting loops on 16-byte strides instead of whole points
+    std::vector<QPointF> positions() const
+    {
+        auto positions = std::vector<QPointF>( _points.size() );
+        for( size_t i = 0; i < _points.size(); ++i )
+            positions[i] = _points[i].position;
+        return positions;
+    }
+    // Sectors of a point with their full geometry, which compute() skips when a deformation field is used and restore()
+    // skips entirely. Counts that were not kept either are recounted for this point alone.
+    std::vector<Sector> sectors( size_t point_index ) const
+    {
+        const auto& point = _points[point_index];
+        if( !_field && point.sectors.size() == _sector_count )
+            return point.sectors;
+
+        auto sectors = std::vector<Sector>( _sector_count );
+        const auto sector_radian_step = 2.0 * std::numbers::pi_v<double> / _sector_count;
+        for( size_t sector_index = 0; sector_index < _sector_count; ++sector_index )
+        {
+            sectors[sector_index] = _domain.sector( point.position, sector_index * sector_radian_step, ( sector_index + 1.0 ) * sector_radian_step );
+            if( point.sectors.size() == _sector_count )
+                sectors[sector_index].points_count = point.sectors[sector_index].points_count;
+            else if( !_points_counts.empty() )
+                sectors[sector_index].points_count = _points_counts[point_index * _sector_count + sector_index];
+        }
+
+        if( point.sectors.size() != _sector_count && _points_counts.empty() )
+        {
+            for( size_t other_point_index = 0; other_point_index < _points.size(); ++other_point_index )
+            {
+                const auto& other_position = _points[other_point_index].position;
+                if( other_point_index == point_index || other_position == point.position )
+                    continue;
+
+                const auto direction = point.position - other_position;
+                const auto t = ( std::atan2( direction.y(), direction.x() ) + std::numbers::pi_v<double> ) / ( 2.0 * std::numbers::pi_v<double> );
+                ++sectors[sector_index( t, _sector_count )].points_count;
+            }
+        }
+
+        for( auto& sector : sectors )
+        {
+            sector.deformation.density = sector.points_count / _points.size() * sector.anchor;
+            sector.deformation.uniform = -sector.area / _domain.total_area() * sector.anchor;
+            sector.deformation.boundary = -0.01 * sector.length / _domain.total_circumference() * sector.anchor;
+        }
+        return sectors;
+    }
+    const auto& domain() const noexcept
+    {
+        return _domain;
+    }
+    size_t sector_count() const noexcept
+    {
+        return _sector_count;
+    }
+    const auto& field() const noexcept
+    {
+        return _field;
+    }
+    double computation_time() const noexcept
+    {
+        return _computation_time;
+    }
+
+    Scatterplot regularize()
+    {
+        std::vector<QPointF> points( _points.size() );
+
+        double absmax = 0.0;
+        for( size_t i = 0; i < _points.size(); ++i )
+        {
+            points[i] = _points[i].position + 0.85 * _points[i].deformation.total;
+            _domain.clamp( points[i] );
+
+            absmax = std::max( absmax, std::abs( points[i].x() ) );
+            absmax = std::max( absmax, std::abs( points[i].y() ) );
+        }
+
+        return Scatterplot { points, _sector_count, _counting, _field, _verbose };
+    }
+
+private:
+    // Maps t = ( atan2( direction ) + pi ) / 2pi in [0, 1] to a sector index
+    static size_t sector_index( double t, size_t sector_count )
+    {
+        return std::min( static_cast<size_t>( std::clamp( t, 0.0, 1.0 ) * sector_count ), sector_count - 1 );
+    }
+
+    void compute()
+    {
+        const auto time_start = std::chrono::high_resolution_clock::now();
+
+        const auto& topology = NumaTopology::system();
+        if( _counting != Counting::symmetric_parallel || topology.nodes().size() <= 1 || !topology.pinnable() || !this->compute_numa( topology ) )
+        {
+            this->compute_sectors( 0, _points.size() );
+
+            // Count sector points
+            switch( _counting )
+            {
+            case Counting::pairwise:
+                this->count_pairwise();
+                break;
+            case Counting::symmetric:
+                this->count_symmetric( this->positions(), 0, 1, [this] ( size_t point_index, size_t sector_index )
+                {
+                    ++_points[point_index].sectors[sector_index].points_count;
+                } );
+                break;
+            case Counting::symmetric_parallel:
+                this->count_symmetric_parallel();
+                break;
+            }
+
+            this->compute_deformation( 0, _points.size() );
+        }
+
+        const auto time_end = std::chrono::high_resolution_clock::now();
+        _computation_time = std::chrono::duration_cast<std::chrono::microseconds>( time_end - time_start ).count() / 1000.0;
+        if( _verbose )
+            std::cout << "Finished computation in " << _computation_time << " ms." << std::endl;
+    }
+
+    // Runs the whole computation on workers pinned to their NUMA nodes. Every worker owns a contiguous range of points (so
+    // every node owns the ranges of its workers), allocates and computes their sectors itself so the pages are first touched
+    // on that node, and counts against a replica of the packed positions and into a count buffer that were both first
+    // touched on the same node. The workers of a node share that buffer, so the memory and the cross-node reads of the
+    // reduction grow with the node count instead of the CPU count. Returns false without touching any point if a worker
+    // could not be pinned; the topology remembers the failure and later computations skip this path.
+    bool compute_numa( const NumaTopology& topology )
+    {
+        struct Worker
+        {
+            const NumaTopology::Node* node {};
+            size_t node_index {};
+            bool replicates {};
+        };
+
+        auto workers = std::vector<Worker> {};
+        for( size_t node_index = 0; node_index < topology.nodes().size(); ++node_index )
+        {
+            const auto& node = topology.nodes()[node_index];
+            for( size_t cpu = 0; cpu < node.cpus.size(); ++cpu )
+                workers.push_back( Worker { &node, node_index, cpu == 0 } );
+        }
+
+        const auto thread_count = workers.size();
+        auto replicas = std::vector<std::vector<QPointF>>( topology.nodes().size() );
+        auto counts = std::vector<std::vector<uint32_t>>( topology.nodes().size() );
+        auto barrier = std::barrier { static_cast<std::ptrdiff_t>( thread_count ) };
+        auto pinned = std::atomic<bool> { true };
+
+        // All workers are spawned, the calling thread must keep its own affinity
+        auto threads = std::vector<std::thread> {};
+        for( size_t thread_index = 0; thread_index < thread_count; ++thread_index )
+        {
+            threads.emplace_back( [this, &topology, &workers, &replicas, &counts, &barrier, &pinned, thread_index, thread_count]
+            {
+                const auto& worker = workers[thread_index];
+                if( !topology.pin( *worker.node ) )
+                    pinned = false;
+
+                // Either every worker runs on its node or the computation falls back to the unpinned path
+                barrier.arrive_and_wait();
+                if( !pinned )
+                    return;
+
+                const auto begin = _points.size() * thread_index / thread_count;
+                const auto end = _points.size() * ( thread_index + 1 ) / thread_count;
+
+                if( worker.replicates )
+                {
+                    replicas[worker.node_index] = this->positions();
+                    counts[worker.node_index].assign( _points.size() * _sector_count, 0 );
+                }
+
+                this->compute_sectors( begin, end );
+                barrier.arrive_and_wait();
+
+                auto& buffer = counts[worker.node_index];
+                this->count_symmetric( replicas[worker.node_index], thread_index, thread_count, [this, &buffer] ( size_t point_index, size_t sector_index )
+                {
+                    std::atomic_ref<uint32_t> { buffer[point_index * _sector_count + sector_index] }.fetch_add( 1, std::memory_order_relaxed );
+                } );
+                barrier.arrive_and_wait();
+
+                this->reduce_counts( counts, begin, end );
+                this->compute_deformation( begin, end );
+            } );
+        }
+
+        for( auto& thread : threads )
+            thread.join();
+
+        return pinned;
+    }
+
+    void compute_sectors( size_t begin, size_t end )
+    {
+        const auto sector_radian_step = 2.0 * std::numbers::pi_v<double> / _sector_count;
+        for( size_t point_index = begin; point_index < end; ++point_index )
+        {
+            auto& current_point = _points[point_index];
+            auto& sectors = current_point.sectors;
+
+            sectors.resize( _sector_count );
+            for( uint32_t sector_index = 0; sector_index < sectors.size(); ++sector_index )
+            {
+                // The field covers the area and length terms, the density term still needs every anchor
+                if( _field )
+                {
+                    sectors[sector_index] = Sector {};
+                    sectors[sector_index].anchor = _domain.exit( current_point.position, _field->anchor_directions()[sector_index] );
+                }
+                else
+                {
+                    const double radian_begin = sector_index * sector_radian_step;
+                    const double radian_end = ( sector_index + 1.0 ) * sector_radian_step;
+                    sectors[sector_index] = _domain.sector( current_point.position, radian_begin, radian_end );
+                }
+            }
+        }
+    }
+
+    void compute_deformation( size_t begin, size_t end )
+    {
+        for( size_t point_index = begin; point_index < end; ++point_index )
+        {
+            auto& current_point = _points[point_index];
+
+            current_point.deformation.density = QPointF { 0.0, 0.0 };
+            current_point.deformation.uniform = QPointF { 0.0, 0.0 };
+            current_point.deformation.boundary = QPointF { 0.0, 0.0 };
+
+            for( auto& sector : current_point.sectors )
+            {
+                sector.deformation.density = sector.points_count / _points.size() * sector.anchor;
+                current_point.deformation.density += sector.deformation.density;
+
+                if( _field )
+                    continue;
+
+                sector.deformation.uniform = -sector.area / _domain.total_area() * sector.anchor;
+                sector.deformation.boundary = -0.01 * sector.length / _domain.total_circumference() * sector.anchor;
+
+                current_point.deformation.uniform += sector.deformation.uniform;
+                current_point.deformation.boundary += sector.deformation.boundary;
+            }
+
+            if( _field )
+            {
+                current_point.deformation.uniform = _field->uniform( current_point.position );
+                current_point.deformation.boundary = _field->boundary( current_point.position );
+            }
+
+            current_point.deformation.total = current_point.deformation.density + current_point.deformation.uniform; // + current_point.deformation.boundary;
+
+            // if( QLineF { current_point.deformation.total, QPointF {} }.length() < 0.005 )
+            //     current_point.deformation.total = QPointF {};
+        }
+    }
+
+    void count_pairwise()
+    {
+        for( size_t current_point_index = 0; current_point_index < _points.size(); ++current_point_index )
+        {
+            auto& sectors = _points[current_point_index].sectors;
+            const auto& current_position = _points[current_point_index].position;
+
+            for( size_t other_point_index = 0; other_point_index < _points.size(); ++other_point_index )
+            {
+                if( current_point_index == other_point_index ) continue;
+
+                const auto& other_position = _points[other_point_index].position;
+                if( other_position == current_position )
+                    continue;
+
+                const auto direction = current_position - other_position;
+                const auto radian = std::atan2( direction.y(), direction.x() );
+
+                const auto t = ( radian + std::numbers::pi_v<double> ) / ( 2.0 * std::numbers::pi_v<double> );
+                ++sectors[sector_index( t, sectors.size() )].points_count;
+            }
+        }
+    }
+
+    // Visits every unordered pair (i, j) with i in { first, first + step, ... } and j > i exactly once. The direction
+    // from j to i is the direction from i to j rotated by pi, i.e. t shifted by one half, so a single atan2 serves both.
+    // Where the shift can disagree with atan2 of the reversed direction, namely a zero y component (atan2 maps both +x
+    // and -x onto the upper half-plane) and shifted values within rounding of a sector boundary, the reversed direction
+    // is evaluated explicitly, so the counts are identical to count_pairwise().
+    template<typename Increment>
+    void count_symmetric( std::span<const QPointF> positions, size_t first, size_t step, Increment&& increment ) const
+    {
+        for( size_t current_point_index = first; current_point_index < positions.size(); current_point_index += step )
+        {
+            const auto& current_position = positions[current_point_index];
+
+            for( size_t other_point_index = current_point_index + 1; other_point_index < positions.size(); ++other_point_index )
+            {
+                const auto& other_position = positions[other_point_index];
+                if( other_position == current_position )
+                    continue;
+
+                const auto direction = current_position - other_position;
+                const auto radian = std::atan2( direction.y(), direction.x() );
+
+                const auto t = ( radian + std::numbers::pi_v<double> ) / ( 2.0 * std::numbers::pi_v<double> );
+                increment( current_point_index, sector_index( t, _sector_count ) );
+
+                auto mirrored = t < 0.5 ? t + 0.5 : t - 0.5;
+                const auto scaled = mirrored * _sector_count;
+                if( direction.y() == 0.0 || std::abs( scaled - std::round( scaled ) ) < 1e-9 )
+                {
+                    const auto reverse = other_position - current_position;
+                    mirrored = ( std::atan2( reverse.y(), reverse.x() ) + std::numbers::pi_v<double> ) / ( 2.0 * std::numbers::pi_v<double> );
+                }
+                increment( other_point_index, sector_index( mirrored, _sector_count ) );
+            }
+        }
+    }
+
+    void count_symmetric_parallel()
+    {
+        const auto thread_count = std::clamp<size_t>( std::thread::hardware_concurrency(), 1, std::max<size_t>( _points.size(), 1 ) );
+        const auto positions = this->positions();
+
+        // Rows are interleaved across threads to balance the triangular workload, each thread owns a full count buffer
+        auto counts = std::vector<std::vector<uint32_t>>( thread_count );
+        parallel( thread_count, [this, &positions, &counts, thread_count] ( size_t thread_index )
+        {
+            auto& buffer = counts[thread_index];
+            buffer.assign( _points.size() * _sector_count, 0 );
+
+            this->count_symmetric( positions, thread_index, thread_count, [this, &buffer] ( size_t point_index, size_t sector_index )
+            {
+                ++buffer[point_index * _sector_count + sector_index];
+            } );
+        } );
+
+        // Reduce the per-thread buffers, each thread owns a contiguous range of points
+        parallel( thread_count, [this, &counts, thread_count] ( size_t thread_index )
+        {
+            this->reduce_counts( counts, _points.size() * thread_index / thread_count, _points.size() * ( thread_index + 1 ) / thread_count );
+        } );
+    }
+
+    void reduce_counts( const std::vector<std::vector<uint32_t>>& counts, size_t begin, size_t end )
+    {
+        for( size_t point_index = begin; point_index < end; ++point_index )
+        {
+            auto& sectors = _points[point_index].sectors;
+            for( size_t sector_index = 0; sector_index < _sector_count; ++sector_index )
+            {
+                uint32_t points_count = 0;
+                for( const auto& buffer : counts )
+                    points_count += buffer[point_index * _sector_count + sector_index];
+                sectors[sector_index].points_count = points_count;
+            }
+        }
+    }
+
+    struct Point
+    {
+        QPointF position {};
+
+        std::vector<Sector> sectors {};
+
+        struct
+        {
+            QPointF density {};
+            QPointF boundary {};
+            QPointF uniform {};
+            QPointF total {};
+        } deformation {};
+    };
+
+    std::vector<Point> _points {};
+    size_t _sector_count {};
+    Counting _counting { Counting::symmetric_parallel };
+    std::shared_ptr<const DeformationField> _field {};
+    bool _verbose { true };
+    std::vector<uint32_t> _points_counts {}; // Restored sector counts, one row per point
+    SquareDomain _domain {};
+    double _computation_time {};
+};
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "scatterplot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <vector>
+
+// Records the position of every point across iterations. Positions are quantized to 16 bits over [-1, 1] and every
+// trajectory is stored contiguously as the deltas between consecutive quantized positions: one signed byte per coordinate,
+// or an escape byte followed by the full 16-bit delta for larger steps. Regularized points mostly move by less than 128
+// quanta per iteration, so a step usually takes 2 instead of 4 bytes. The deltas wrap around, so decoding (sequentially
+// from the first iteration) reproduces the quantized positions exactly.
+class TrajectoryStore
+{
+public:
+    TrajectoryStore() noexcept = default;
+
+    size_t size() const noexcept
+    {
+        return _points_count;
+    }
+    size_t iterations() const noexcept
+    {
+        return _iterations;
+    }
+    size_t memory() const noexcept
+    {
+        auto memory = _previous.size() * sizeof( uint16_t );
+        for( const auto& trajectory : _trajectories )
+            memory += trajectory.size();
+        return memory;
+    }
+
+    void clear()
+    {
+        *this = TrajectoryStore {};
+    }
+
+    void append( const Scatterplot& scatterplot )
+    {
+        const auto& points = scatterplot.points();
+        if( _iterations == 0 )
+        {
+            _points_count = points.size();
+            _previous.assign( 2 * _points_count, 0 );
+            _trajectories.assign( _points_count, {} );
+        }
+
+        for( size_t point_index = 0; point_index < _points_count; ++point_index )
+        {
+            const uint16_t x = quantize( points[point_index].position.x() );
+            const uint16_t y = quantize( points[point_index].position.y() );
+
+            auto& trajectory = _trajectories[point_index];
+            encode( trajectory, static_cast<uint16_t>( x - _previous[2 * point_index + 0] ) );
+            encode( trajectory, static_cast<uint16_t>( y - _previous[2 * point_index + 1] ) );
+
+            _previous[2 * point_index + 0] = x;
+            _previous[2 * point_index + 1] = y;
+        }
+
+        ++_iterations;
+    }
+
+    // Calls 'callback( iteration, position )' for the first 'count' recorded positions of the point
+    template<typename Callback>
+    void trajectory( size_t point_index, size_t count, Callback&& callback ) const
+    {
+        if( point_index >= _points_count )
+            return;
+
+        const auto& trajectory = _trajectories[point_index];
+
+        size_t offset = 0;
+        uint16_t x = 0;
+        uint16_t y = 0;
+        for( size_t iteration = 0; iteration < std::min( count, _iterations ); ++iteration )
+        {
+            x += decode( trajectory, offset );
+            y += decode( trajectory, offset );
+            callback( iteration, QPointF { dequantize( x ), dequantize( y ) } );
+        }
+    }
+
+    void export_csv( std::ostream& stream, size_t count ) const
+    {
+        stream << "point_index,iteration,x,y\n";
+        for( size_t point_index = 0; point_index < _points_count; ++point_index )
+        {
+            this->trajectory( point_index, count, [&stream, point_index] ( size_t iteration, QPointF position )
+            {
+                stream << point_index << ',' << iteration << ',' << position.x() << ',' << position.y() << '\n';
+            } );
+        }
+    }
+
+private:
+    static constexpr uint8_t escape = 0x80; // -128 never occurs as a short delta
+
+    static uint16_t quantize( double value )
+    {
+        return static_cast<uint16_t>( std::lround( ( std::clamp( value, -1.0, 1.0 ) + 1.0 ) / 2.0 * 65535.0 ) );
+    }
+    static double dequantize( uint16_t value )
+    {
+        return value / 65535.0 * 2.0 - 1.0;
+    }
+
+    static void encode( std::vector<uint8_t>& trajectory, uint16_t delta )
+    {
+        const auto value = static_cast<int16_t>( delta );
+        if( value > -128 && value < 128 )
+        {
+            trajectory.push_back( static_cast<uint8_t>( value ) );
+        }
+        else
+        {
+            trajectory.push_back( escape );
+            trajectory.push_back( static_cast<uint8_t>( delta & 0xff ) );
+            trajectory.push_back( static_cast<uint8_t>( delta >> 8 ) );
+        }
+    }
+    static uint16_t decode( const std::vector<uint8_t>& trajectory, size_t& offset )
+    {
+        const auto byte = trajectory[offset++];
+        if( byte != escape )
+            return static_cast<uint16_t>( static_cast<int8_t>( byte ) );
+
+        const auto delta = static_cast<uint16_t>( trajectory[offset] | trajectory[offset + 1] << 8 );
+        offset += 2;
+        return delta;
+    }
+
+    std::vector<std::vector<uint8_t>> _trajectories {}; // Encoded deltas of every point, [iteration][x, y]
+    std::vector<uint16_t> _previous {};                 // Last quantized position of every point
+    size_t _points_count {};
+    size_t _iterations {};
+};